@@ -2,6 +2,16 @@
 #include <stdlib.h>      // Biblioteca para alocao dinmica (malloc, realloc, free)
 #include <string.h>      // Biblioteca para manipulao de strings (strcmp, strcpy)
 #include <locale.h>      // Biblioteca para configurar idioma/acentuao no terminal
+#include <time.h>        // Biblioteca para medir tempo (clock), usada no benchmark da agenda
+#include <errno.h>       // errno: distinguir arquivo ocupado de erro ao travar alteracoes.txt
+#include <limits.h>      // INT_MAX: IDs de ordem digitados na remoo em lote
+#ifdef _WIN32
+#include <io.h>          // _fileno e _locking: trava do arquivo de alteraes no Windows
+#include <sys/locking.h>
+#else
+#include <sys/file.h>    // flock: trava do arquivo de alteraes no Linux/macOS
+#include <unistd.h>      // ftruncate: apagar um evento gravado pela metade
+#endif
 
 #define MAX 100
 
@@ -53,6 +63,7 @@ Cliente *clientes = NULL;
 Veiculo *veiculos = NULL;
 OrdemServico *ordens = NULL;
 int qtdClientes = 0, qtdVeiculos = 0, qtdOrdens = 0;
+int ultimoIdOrdem = 0; // Maior ID de ordem j usado, inclusive de ordens removidas (ver ultimoidordem.txt)
 
 // ---------- Validaes ----------
 
@@ -151,6 +162,14 @@ int dataValida(const char *data) {
     return 1;
 }
 
+// Funo: dataChave
+// Objetivo: converter "dd/mm/aaaa" em um nmero aaaammdd, que pode ser comparado diretamente.
+int dataChave(const char *data) {
+    int dia = 0, mes = 0, ano = 0;
+    sscanf(data, "%d/%d/%d", &dia, &mes, &ano);
+    return ano * 10000 + mes * 100 + dia;
+}
+
 // ---------- Persistncia ----------
 // Essas funes cuidam da "persistncia" dos dados,
 // ou seja, salvam e carregam as informaes dos arquivos de texto.
@@ -259,14 +278,36 @@ void carregarOrdens() {
 
     OrdemServico temp; // Estrutura temporria para armazenar dados lidos
     char placa[10];  // Varivel para guardar a placa do veculo da ordem
+    char linha[256];
 
     // L cada linha do arquivo no formato: id;placa;dataEntrada;descricao;status
-    while (fscanf(f, "%d;%9[^;];%10[^;];%99[^;];%d\n",
-            &temp.id, placa, temp.dataEntrada, temp.descricao, (int*)&temp.status) == 5) {
+    // Os campos so separados  mo (e no com fscanf) porque a placa pode vir vazia:
+    // uma ordem cujo veculo foi removido  gravada como "1;;10/01/2024;freio;1".
+    while (fgets(linha, sizeof(linha), f)) {
+        linha[strcspn(linha, "\r\n")] = '\0';
+
+        // id, placa e data so os trs primeiros campos; o status  o ltimo.
+        // O que sobra no meio  a descrio.
+        char *campo[3], *p = linha;
+        int n = 0;
+        while (n < 3 && p) {
+            campo[n++] = p;
+            p = strchr(p, ';');
+            if (p) *p++ = '\0';
+        }
+        char *ultimo = p ? strrchr(p, ';') : NULL;
+        if (n < 3 || !ultimo) continue; // Linha incompleta: ignora
+        *ultimo = '\0';
 
-        // Procura o veculo correspondente  placa lida
+        temp.id = atoi(campo[0]);
+        snprintf(placa, sizeof(placa), "%.9s", campo[1]);
+        snprintf(temp.dataEntrada, sizeof(temp.dataEntrada), "%.10s", campo[2]);
+        snprintf(temp.descricao, sizeof(temp.descricao), "%.99s", p);
+        temp.status = (Status)atoi(ultimo + 1);
+
+        // Procura o veculo correspondente  placa lida (placa vazia = ordem sem veculo)
         Veiculo *v = NULL;
-        for (int j = 0; j < qtdVeiculos; j++)
+        for (int j = 0; placa[0] && j < qtdVeiculos; j++)
             if (strcmp(veiculos[j].placa, placa) == 0) v = &veiculos[j];
 
         temp.veiculo = v;  // Associa o ponteiro do veculo (ou NULL, se no achar)
@@ -278,10 +319,940 @@ void carregarOrdens() {
 
         // Copia a ordem temporria para o vetor principal e atualiza o contador
         ordens[qtdOrdens++] = temp;
+        if (temp.id > ultimoIdOrdem) ultimoIdOrdem = temp.id; // Arquivos antigos podem estar fora de ordem
     }
     fclose(f);  // Fecha o arquivo aps carregar todas as ordens
 }
 
+// ----------- LTIMO ID DE ORDEM -----------
+// O maior ID de ordem j usado fica em ultimoidordem.txt. Ele no pode vir s de
+// ordens.txt: depois de remover a ordem de maior ID (ou todas), o ID seria reutilizado
+// e quem acompanha o fluxo de alteraes confundiria a ordem nova com a removida.
+void salvarUltimoIdOrdem() {
+    FILE *f = fopen("ultimoidordem.txt", "w");
+    if (!f) return;
+    fprintf(f, "%d\n", ultimoIdOrdem);
+    fclose(f);
+}
+// Deve ser chamada depois de carregarOrdens (que j considera os IDs carregados)
+void carregarUltimoIdOrdem() {
+    int id = 0;
+    FILE *f = fopen("ultimoidordem.txt", "r");
+    if (f) {
+        if (fscanf(f, "%d", &id) == 1 && id > ultimoIdOrdem) ultimoIdOrdem = id;
+        fclose(f);
+        return;
+    }
+
+    // Arquivo ainda no existe (dados de uma verso anterior): procura o maior ID
+    // de ordem que j apareceu no fluxo de alteraes, inclusive em remoes
+    f = fopen("alteracoes.txt", "r");
+    if (!f) return;
+    char linha[512];
+    while (fgets(linha, sizeof(linha), f))
+        if (sscanf(linha, "%*u;%*c;ordem;%d;", &id) == 1 && id > ultimoIdOrdem) ultimoIdOrdem = id;
+    fclose(f);
+}
+
+// ---------- Fluxo de alteraes ----------
+// Cada incluso, atualizao ou remoo  anexada ao arquivo alteracoes.txt,
+// uma linha por evento, no formato: sequencia;operacao;entidade;chave;registro
+//   operacao: I (incluso), U (atualizao) ou D (remoo)
+//   entidade: cliente, veiculo ou ordem
+//   registro: os campos do registro no mesmo formato do arquivo da entidade
+// A sequncia nunca se repete, ento sistemas externos (cobrana, SMS...) guardam
+// o ltimo nmero processado e leem s o que veio depois (ver listarAlteracoes).
+// Como mais de um programa pode estar aberto ao mesmo tempo, cada evento  gravado
+// com o arquivo travado, e o nmero seguinte  sempre tirado da ltima linha do
+// arquivo (e no de um contador em memria).
+// O '\n' marca o fim de cada evento: ele s  gravado depois do registro inteiro, e
+// uma linha que ficou sem ele (programa interrompido no meio da gravao)  apagada
+// antes do prximo evento. Os campos podem conter ';', ento o fim do registro
+// no  deduzido pela quantidade de campos.
+
+FILE *arquivoAlteracoes = NULL;     // Mantido aberto para leitura e anexao
+
+// Funo: abrirAlteracoes
+// Objetivo: abrir o arquivo para anexar novos eventos (e ler a ltima sequncia).
+void abrirAlteracoes() {
+    arquivoAlteracoes = fopen("alteracoes.txt", "a+");
+}
+
+// Funo: travarAlteracoes / destravarAlteracoes
+// Objetivo: garantir que s um programa por vez escolha a sequncia e grave um evento.
+// travarAlteracoes espera enquanto outro programa estiver com a trava; se a trava
+// falhar por outro motivo, retorna 0 (e o evento no deve ser gravado).
+int travarAlteracoes() {
+#ifdef _WIN32
+    fseek(arquivoAlteracoes, 0, SEEK_SET);
+    while (_locking(_fileno(arquivoAlteracoes), _LK_LOCK, 1) != 0) {
+        if (errno != EDEADLOCK) return 0; // EDEADLOCK: _LK_LOCK desistiu aps ~10 s com o arquivo ocupado
+    }
+#else
+    while (flock(fileno(arquivoAlteracoes), LOCK_EX) != 0) {
+        if (errno != EINTR) return 0; // EINTR: espera interrompida por um sinal
+    }
+#endif
+    return 1;
+}
+void destravarAlteracoes() {
+#ifdef _WIN32
+    fseek(arquivoAlteracoes, 0, SEEK_SET);
+    _locking(_fileno(arquivoAlteracoes), _LK_UNLCK, 1);
+#else
+    flock(fileno(arquivoAlteracoes), LOCK_UN);
+#endif
+}
+
+// Funo: ultimaSequencia
+// Objetivo: ler o nmero de sequncia da ltima linha do arquivo (0 se estiver vazio).
+// L s o fim do arquivo; se a ltima linha estiver incompleta (programa interrompido
+// no meio da gravao), percorre o arquivo inteiro atrs do maior nmero.
+unsigned long ultimaSequencia() {
+    FILE *f = arquivoAlteracoes;
+    char buf[1024];
+    fseek(f, 0, SEEK_END);
+    long tam = ftell(f);
+    if (tam <= 0) return 0;
+
+    long ini = tam > (long)sizeof(buf) - 1 ? tam - (long)sizeof(buf) + 1 : 0;
+    fseek(f, ini, SEEK_SET);
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    buf[n] = '\0';
+
+    unsigned long seq = 0;
+    char *fimLinha = strrchr(buf, '\n');
+    if (fimLinha && fimLinha[1] == '\0') { // A ltima linha terminou de ser gravada
+        *fimLinha = '\0';
+        char *inicioLinha = strrchr(buf, '\n');
+        inicioLinha = inicioLinha ? inicioLinha + 1 : (ini == 0 ? buf : NULL);
+        if (inicioLinha && sscanf(inicioLinha, "%lu;", &seq) == 1) return seq;
+    }
+
+    // Caso raro: procura o maior nmero em todas as linhas
+    char linha[512];
+    unsigned long s;
+    fseek(f, 0, SEEK_SET);
+    while (fgets(linha, sizeof(linha), f))
+        if (sscanf(linha, "%lu;", &s) == 1 && s > seq) seq = s;
+    return seq;
+}
+
+// Funo: apagarEventoIncompleto
+// Objetivo: se a ltima linha no terminou com '\n' (gravao interrompida), apag-la,
+// para que toda linha terminada em '\n' seja um evento inteiro. Deve ser chamada com
+// o arquivo travado. A linha cortada nunca foi entregue (ver listarAlteracoes).
+// Retorna 0 se no conseguir apag-la (o prximo evento se juntaria a ela).
+int apagarEventoIncompleto() {
+    FILE *f = arquivoAlteracoes;
+    fseek(f, 0, SEEK_END);
+    long tam = ftell(f), pos = tam;
+    // Volta at logo depois do ltimo '\n' (a linha cortada  curta)
+    while (pos > 0) {
+        fseek(f, pos - 1, SEEK_SET);
+        if (fgetc(f) == '\n') break;
+        pos--;
+    }
+    if (pos == tam) return 1;
+    fflush(f);
+#ifdef _WIN32
+    int ok = _chsize(_fileno(f), pos) == 0;
+#else
+    int ok = ftruncate(fileno(f), pos) == 0;
+#endif
+    fseek(f, 0, SEEK_END);
+    return ok;
+}
+
+// Funo: iniciarEvento
+// Objetivo: travar o arquivo e gravar o cabealho de um evento (sequncia, operao,
+// entidade e chave). Deve ser seguida de finalizarEvento.
+// Retorna 0 se o arquivo de alteraes no estiver disponvel ou no puder ser travado.
+int iniciarEvento(char operacao, const char *entidade, const char *chave) {
+    if (!arquivoAlteracoes) return 0;
+    if (!travarAlteracoes()) {
+        // Gravar sem a trava poderia repetir a sequncia de outro programa
+        printf("Aviso: no foi possvel travar alteracoes.txt; evento de %s %s no registrado.\n", entidade, chave);
+        return 0;
+    }
+    if (!apagarEventoIncompleto()) {
+        printf("Aviso: no foi possvel corrigir alteracoes.txt; evento de %s %s no registrado.\n", entidade, chave);
+        destravarAlteracoes();
+        return 0;
+    }
+    unsigned long seq = ultimaSequencia() + 1;
+    fseek(arquivoAlteracoes, 0, SEEK_END);
+    fprintf(arquivoAlteracoes, "%lu;%c;%s;%s;", seq, operacao, entidade, chave);
+    return 1;
+}
+
+// Funo: finalizarEvento
+// Objetivo: deixar o evento visvel imediatamente para os consumidores e soltar a trava.
+void finalizarEvento() {
+    fflush(arquivoAlteracoes);
+    destravarAlteracoes();
+}
+
+void publicarCliente(char operacao, const Cliente *c) {
+    if (!iniciarEvento(operacao, "cliente", c->cpf)) return;
+    fprintf(arquivoAlteracoes, "%s;%s;%s\n", c->nome, c->cpf, c->telefone);
+    finalizarEvento();
+}
+
+void publicarVeiculo(char operacao, const Veiculo *v) {
+    if (!iniciarEvento(operacao, "veiculo", v->placa)) return;
+    // Mesmo formato de salvarVeiculos: sem dono, o campo do CPF  gravado como ";"
+    fprintf(arquivoAlteracoes, "%s;%s;%d;%s\n", v->placa, v->modelo, v->ano, v->dono ? v->dono->cpf : ";");
+    finalizarEvento();
+}
+
+void publicarOrdem(char operacao, const OrdemServico *o) {
+    char chave[12];
+    snprintf(chave, sizeof(chave), "%d", o->id);
+    if (!iniciarEvento(operacao, "ordem", chave)) return;
+    fprintf(arquivoAlteracoes, "%d;%s;%s;%s;%d\n",
+        o->id, o->veiculo ? o->veiculo->placa : "", o->dataEntrada, o->descricao, (int)o->status);
+    finalizarEvento();
+}
+
+// Funo: cabecalhoEvento
+// Objetivo: conferir o comeo de um evento (sequencia;operacao;entidade;) e guardar a
+// sequncia em 'seq'. A chave e o registro no so conferidos, porque podem conter ';'.
+// Quem chama j conferiu que a linha termina em '\n', ou seja, que o evento est inteiro.
+int cabecalhoEvento(const char *linha, unsigned long *seq) {
+    char operacao, entidade[10];
+    int n = 0;
+    if (sscanf(linha, "%lu;%c;%9[^;];%n", seq, &operacao, entidade, &n) != 3 || n == 0)
+        return 0;
+    if (operacao != 'I' && operacao != 'U' && operacao != 'D') return 0;
+    return strcmp(entidade, "cliente") == 0 || strcmp(entidade, "veiculo") == 0 ||
+           strcmp(entidade, "ordem") == 0;
+}
+
+// Funo: proximoEvento
+// Objetivo: ler a partir da posio atual at achar uma linha que seja um evento completo.
+// Uma linha sem '\n' no fim do arquivo ainda est sendo gravada (ou foi cortada e ser
+// apagada pelo prximo evento) e  pulada.
+// Retorna 0 no fim do arquivo.
+int proximoEvento(FILE *f, char *linha, int tam, unsigned long *seq) {
+    while (fgets(linha, tam, f)) {
+        size_t n = strcspn(linha, "\n");
+        if (linha[n] != '\n') { // Linha incompleta ou longa demais: descarta o resto dela
+            int c;
+            while ((c = fgetc(f)) != '\n' && c != EOF) {}
+            continue;
+        }
+        linha[strcspn(linha, "\r\n")] = '\0';
+        if (cabecalhoEvento(linha, seq)) return 1;
+    }
+    return 0;
+}
+
+// Funo: posicionarNaLinha
+// Objetivo: levar o arquivo ao comeo da primeira linha que comea em 'pos' ou depois.
+void posicionarNaLinha(FILE *f, long pos) {
+    if (pos == 0) { fseek(f, 0, SEEK_SET); return; }
+    fseek(f, pos - 1, SEEK_SET);
+    int c;
+    while ((c = fgetc(f)) != '\n' && c != EOF) {}
+}
+
+// Funo: listarAlteracoes
+// Objetivo: imprimir na sada padro todos os eventos com sequncia maior que 'desde'.
+// Usada pelos consumidores para retomar a leitura de onde pararam. Como as sequncias
+// crescem ao longo do arquivo, a primeira linha com sequncia maior que 'desde'  achada
+// por busca binria nas posies do arquivo, e s o que vem depois dela  lido.
+void listarAlteracoes(unsigned long desde) {
+    FILE *f = fopen("alteracoes.txt", "rb"); // Binrio: posies em bytes para o fseek
+    if (!f) return; // Nenhuma alterao registrada ainda
+
+    char linha[512];
+    unsigned long seq;
+    fseek(f, 0, SEEK_END);
+    long ini = 0, fim = ftell(f);
+
+    // Menor posio cuja linha seguinte j  um evento novo (ou o fim do arquivo)
+    while (ini < fim) {
+        long meio = ini + (fim - ini) / 2;
+        posicionarNaLinha(f, meio);
+        if (!proximoEvento(f, linha, sizeof(linha), &seq) || seq > desde) fim = meio;
+        else ini = meio + 1;
+    }
+
+    posicionarNaLinha(f, ini);
+    while (proximoEvento(f, linha, sizeof(linha), &seq))
+        if (seq > desde) printf("%s\n", linha);
+    fclose(f);
+}
+
+// ---------- Snapshots (leitura consistente) ----------
+// Relatrios leem de um snapshot em vez dos vetores globais, ento uma alterao feita
+// no meio da leitura (ou uma remoo que desloca o vetor) no aparece pela metade.
+// Nada  copiado ao abrir um snapshot: cada tabela tem uma verso com contador de
+// referncias, e o leitor apenas passa a compartilhar o vetor em uso (copy-on-write).
+// O prprio vetor global conta como uma referncia. Antes de alterar uma tabela,
+// quem escreve chama prepararEscrita*: se algum leitor ainda usa a verso, s essa
+// tabela  copiada e a escrita vai para a cpia; o leitor continua com o bloco antigo,
+// que  liberado quando a ltima referncia for devolvida.
+
+typedef struct {
+    int referencias;   // O vetor em uso (enquanto for esta verso) mais cada leitor
+    void *itens;       // Bloco com os registros desta verso
+    int qtd;
+} VersaoTabela;
+
+// Verso atual de cada tabela; NULL enquanto nenhum leitor a abriu desde a ltima escrita
+VersaoTabela *versaoClientes = NULL;
+VersaoTabela *versaoVeiculos = NULL;
+VersaoTabela *versaoOrdens = NULL;
+
+typedef struct {
+    VersaoTabela *versaoClientes, *versaoVeiculos, *versaoOrdens;
+    Cliente *clientes;
+    Veiculo *veiculos;
+    OrdemServico *ordens;
+    int qtdClientes, qtdVeiculos, qtdOrdens;
+} Snapshot;
+
+// Funo: soltarVersao
+// Objetivo: devolver uma referncia; quando ningum mais usa o bloco, libera a memria.
+void soltarVersao(VersaoTabela *v) {
+    if (!v || --v->referencias > 0) return;
+    free(v->itens);
+    free(v);
+}
+
+// Funo: compartilharVersao
+// Objetivo: dar ao leitor uma referncia para a verso atual da tabela, criando-a se
+// for a primeira leitura desde a ltima escrita. Retorna NULL se faltar memria.
+VersaoTabela* compartilharVersao(VersaoTabela **atual, void *itens, int qtd) {
+    if (!*atual) {
+        VersaoTabela *v = malloc(sizeof(VersaoTabela));
+        if (!v) return NULL;
+        v->referencias = 1; // Referncia do vetor em uso
+        v->itens = itens;
+        v->qtd = qtd;
+        *atual = v;
+    }
+    (*atual)->referencias++;
+    return *atual;
+}
+
+// Funo: separarVersao
+// Objetivo: liberar a tabela para escrita. Se a verso atual no tem leitores, ela 
+// apenas descartada; se tem, '*itens' passa a apontar para uma cpia do vetor e os
+// leitores ficam com o bloco antigo. Retorna 0 se faltar memria (nada  alterado).
+int separarVersao(VersaoTabela **atual, void **itens, int qtd, size_t tamItem) {
+    VersaoTabela *v = *atual;
+    if (!v) return 1;
+    if (v->referencias == 1) { // Ningum est lendo: escreve direto no vetor em uso
+        free(v);
+        *atual = NULL;
+        return 1;
+    }
+
+    void *copia = NULL;
+    if (qtd > 0) {
+        copia = malloc(qtd * tamItem);
+        if (!copia) return 0;
+        memcpy(copia, *itens, qtd * tamItem);
+    }
+    v->referencias--; // O bloco antigo fica s com os leitores
+    *atual = NULL;
+    *itens = copia;
+    return 1;
+}
+
+// Funo: prepararEscritaOrdens / prepararEscritaVeiculos / prepararEscritaClientes
+// Objetivo: chamar antes de qualquer alterao na tabela. Quando a tabela  copiada,
+// os ponteiros que outra tabela guarda para ela so refeitos para a cpia; por isso
+// essa outra tabela  preparada antes (ordens apontam para veculos, veculos para clientes).
+// Retornam 0 se faltar memria.
+int prepararEscritaOrdens() {
+    void *itens = ordens;
+    if (!separarVersao(&versaoOrdens, &itens, qtdOrdens, sizeof(OrdemServico))) return 0;
+    ordens = itens;
+    return 1;
+}
+
+int prepararEscritaVeiculos() {
+    if (versaoVeiculos && versaoVeiculos->referencias > 1 && !prepararEscritaOrdens()) return 0;
+    Veiculo *antes = veiculos;
+    void *itens = veiculos;
+    if (!separarVersao(&versaoVeiculos, &itens, qtdVeiculos, sizeof(Veiculo))) return 0;
+    veiculos = itens;
+    if (veiculos != antes)
+        for (int i = 0; i < qtdOrdens; i++) {
+            Veiculo *v = ordens[i].veiculo;
+            if (v >= antes && v < antes + qtdVeiculos) ordens[i].veiculo = veiculos + (v - antes);
+        }
+    return 1;
+}
+
+int prepararEscritaClientes() {
+    if (versaoClientes && versaoClientes->referencias > 1 && !prepararEscritaVeiculos()) return 0;
+    Cliente *antes = clientes;
+    void *itens = clientes;
+    if (!separarVersao(&versaoClientes, &itens, qtdClientes, sizeof(Cliente))) return 0;
+    clientes = itens;
+    if (clientes != antes)
+        for (int i = 0; i < qtdVeiculos; i++) {
+            Cliente *d = veiculos[i].dono;
+            if (d >= antes && d < antes + qtdClientes) veiculos[i].dono = clientes + (d - antes);
+        }
+    return 1;
+}
+
+// Funo: liberarSnapshot
+// Objetivo: devolver as referncias do leitor.
+void liberarSnapshot(Snapshot *s) {
+    if (!s) return;
+    soltarVersao(s->versaoClientes);
+    soltarVersao(s->versaoVeiculos);
+    soltarVersao(s->versaoOrdens);
+    free(s);
+}
+
+// Funo: abrirSnapshot
+// Objetivo: obter uma viso consistente dos dados. Deve ser devolvida com liberarSnapshot.
+// Os ponteiros entre tabelas (dono, veiculo) j apontam para os blocos do snapshot,
+// porque as trs verses so tiradas no mesmo momento. Retorna NULL se faltar memria.
+Snapshot* abrirSnapshot() {
+    Snapshot *s = calloc(1, sizeof(Snapshot));
+    if (!s) return NULL;
+    if (!(s->versaoClientes = compartilharVersao(&versaoClientes, clientes, qtdClientes)) ||
+        !(s->versaoVeiculos = compartilharVersao(&versaoVeiculos, veiculos, qtdVeiculos)) ||
+        !(s->versaoOrdens = compartilharVersao(&versaoOrdens, ordens, qtdOrdens))) {
+        liberarSnapshot(s);
+        return NULL;
+    }
+    s->clientes = s->versaoClientes->itens;
+    s->qtdClientes = s->versaoClientes->qtd;
+    s->veiculos = s->versaoVeiculos->itens;
+    s->qtdVeiculos = s->versaoVeiculos->qtd;
+    s->ordens = s->versaoOrdens->itens;
+    s->qtdOrdens = s->versaoOrdens->qtd;
+    return s;
+}
+
+// ---------- Agenda de boxes e mecnicos ----------
+// Distribui as ordens abertas (aguardando avaliao ou em reparo) entre os boxes e
+// mecnicos da oficina. Cada ordem ocupa um box e um mecnico ao mesmo tempo, pela
+// durao estimada, e nunca comea antes do dia em que deu entrada na oficina.
+// A agenda  montada simulando o tempo: sempre que houver um box e um mecnico livres,
+// comea a ordem de maior prioridade entre as que j deram entrada (fila de prioridade:
+// primeiro as que j esto em reparo, depois pela data de entrada mais antiga, com
+// desempate pelo ID). Assim, uma ordem que s chega depois no segura os boxes
+// enquanto as que j esto na oficina esperam.
+//
+// A semana comea em uma data escolhida (hoje, por padro). Os horrios so contados
+// em minutos teis desde o incio dela (MINUTOS_POR_DIA por dia, comeando s 08:00,
+// de segunda a sexta).
+//
+// O que comea antes de um minuto T s depende das ordens que comearam antes de T.
+// Quando uma ordem muda (status, data, nova ordem), s  preciso refazer a agenda
+// a partir do menor entre o incio antigo dela e o dia em que pode comear agora
+// (ver agendaAtualizarOrdem).
+
+#define NUM_BOXES 4            // Boxes (elevadores) disponveis
+#define NUM_MECANICOS 5        // Mecnicos disponveis
+#define MINUTOS_POR_DIA 480    // Jornada de 8 horas
+#define DIAS_POR_SEMANA 5
+#define DURACAO_AVALIACAO 60   // Minutos estimados para avaliar o veculo
+#define DURACAO_REPARO 180     // Minutos estimados para o reparo
+
+typedef struct {
+    int id;            // ID da ordem de servio
+    int prioridade;    // 0 = em reparo, 1 = aguardando avaliao
+    int data;          // Data de entrada no formato aaaammdd
+    int duracao;       // Minutos estimados
+    int liberada;      // Minuto til a partir do qual pode comear (dia de entrada)
+    int box, mecanico; // Recursos atribudos
+    int inicio, fim;   // Minutos teis desde o incio da semana
+    char placa[10];
+} Agendamento;
+
+Agendamento *agenda = NULL;   // Agendamentos em ordem de incio
+int qtdAgenda = 0, capAgenda = 0;
+int agendaValida = 0;          // 0 = precisa ser montada de novo
+int diaInicioAgenda = 0;       // Primeiro dia da semana agendada (ver diaUtil)
+
+// Funo: diaUtil
+// Objetivo: numerar os dias teis (segunda a sexta) de uma data aaaammdd, de modo que
+// a diferena entre duas datas seja a quantidade de dias teis entre elas.
+// Sbado e domingo recebem o nmero da segunda-feira seguinte.
+int diaUtil(int chave) {
+    int ano = chave / 10000, mes = chave / 100 % 100, dia = chave % 100;
+    // Dias desde 01/01/1970 (calendrio gregoriano, com o ano comeando em maro)
+    if (mes <= 2) ano--;
+    int era = ano / 400, anoDaEra = ano - era * 400;
+    int diaDoAno = (153 * (mes > 2 ? mes - 3 : mes + 9) + 2) / 5 + dia - 1;
+    int dias = era * 146097 + anoDaEra * 365 + anoDaEra / 4 - anoDaEra / 100 + diaDoAno - 719468;
+
+    int desdeSegunda = dias + 3; // 01/01/1970 foi uma quinta-feira
+    int diaDaSemana = desdeSegunda % 7; // 0 = segunda ... 6 = domingo
+    return desdeSegunda / 7 * 5 + (diaDaSemana < 5 ? diaDaSemana : 5);
+}
+
+// Funo: definirInicioAgenda
+// Objetivo: ancorar a semana da agenda em uma data aaaammdd. Se a data mudou, os
+// horrios de todas as ordens mudam e a agenda  montada de novo na prxima consulta.
+void definirInicioAgenda(int chave) {
+    int dia = diaUtil(chave);
+    if (dia != diaInicioAgenda) {
+        diaInicioAgenda = dia;
+        agendaValida = 0;
+    }
+}
+
+// Funo: ordemAgendavel
+// Objetivo: s ordens aguardando avaliao ou em reparo ocupam box e mecnico.
+int ordemAgendavel(const OrdemServico *o) {
+    return o->status == AGUARDANDO_AVALIACAO || o->status == EM_REPARO;
+}
+
+// Funo: preencherAgendamento
+// Objetivo: montar a chave de prioridade e a durao estimada de uma ordem.
+void preencherAgendamento(Agendamento *a, const OrdemServico *o) {
+    memset(a, 0, sizeof(*a));
+    a->id = o->id;
+    a->prioridade = (o->status == EM_REPARO) ? 0 : 1;
+    a->data = dataChave(o->dataEntrada);
+    int dias = diaUtil(a->data) - diaInicioAgenda; // Entrada antes da semana: j est disponvel
+    a->liberada = dias > 0 ? dias * MINUTOS_POR_DIA : 0;
+    // Quem ainda no foi avaliado precisa da avaliao e do reparo
+    a->duracao = (o->status == EM_REPARO) ? DURACAO_REPARO : DURACAO_AVALIACAO + DURACAO_REPARO;
+    snprintf(a->placa, sizeof(a->placa), "%s", o->veiculo ? o->veiculo->placa : "");
+}
+
+// Funo: compararAgendamentos
+// Objetivo: chave da fila de prioridade (status, data de entrada e ID).
+int compararAgendamentos(const Agendamento *a, const Agendamento *b) {
+    if (a->prioridade != b->prioridade) return a->prioridade - b->prioridade;
+    if (a->data != b->data) return (a->data > b->data) - (a->data < b->data);
+    return (a->id > b->id) - (a->id < b->id);
+}
+
+// Funo: descerFila
+// Objetivo: restaurar o heap de mnimo a partir da posio i.
+void descerFila(Agendamento *fila, int n, int i) {
+    Agendamento item = fila[i];
+    for (;;) {
+        int filho = 2*i + 1;
+        if (filho >= n) break;
+        if (filho + 1 < n && compararAgendamentos(&fila[filho+1], &fila[filho]) < 0) filho++;
+        if (compararAgendamentos(&fila[filho], &item) >= 0) break;
+        fila[i] = fila[filho];
+        i = filho;
+    }
+    fila[i] = item;
+}
+
+// Funo: subirFila
+// Objetivo: inserir 'item' no heap de mnimo com 'n' itens (a fila passa a ter n+1).
+void subirFila(Agendamento *fila, int n, Agendamento item) {
+    int i = n;
+    while (i > 0 && compararAgendamentos(&item, &fila[(i-1)/2]) < 0) {
+        fila[i] = fila[(i-1)/2];
+        i = (i-1)/2;
+    }
+    fila[i] = item;
+}
+
+// Funo: compararLiberacao
+// Objetivo: ordenar (qsort) os agendamentos pelo minuto em que podem comear.
+int compararLiberacao(const void *a, const void *b) {
+    int x = ((const Agendamento*)a)->liberada, y = ((const Agendamento*)b)->liberada;
+    return (x > y) - (x < y);
+}
+
+// Funo: garantirCapacidadeAgenda
+// Objetivo: garantir espao para 'n' agendamentos (dobrando a capacidade). Retorna 0 se faltar memria.
+int garantirCapacidadeAgenda(int n) {
+    if (n <= capAgenda) return 1;
+    int cap = capAgenda ? capAgenda : 64;
+    while (cap < n) cap *= 2;
+    Agendamento *novo = realloc(agenda, cap * sizeof(Agendamento));
+    if (!novo) return 0;
+    agenda = novo;
+    capAgenda = cap;
+    return 1;
+}
+
+// Funo: menorLivre
+// Objetivo: achar o box (ou mecnico) que fica livre primeiro. Poucos boxes e
+// mecnicos: uma busca linear basta.
+int menorLivre(const int *livre, int n) {
+    int r = 0;
+    for (int j = 1; j < n; j++) if (livre[j] < livre[r]) r = j;
+    return r;
+}
+
+// Funo: replanejarAPartirDe
+// Objetivo: refazer a agenda da posio 'p' em diante, a partir do minuto 'desde'.
+// Os agendamentos antes de 'p' (todos comeam antes de 'desde') ficam como esto; os
+// demais so distribudos de novo simulando o tempo (ver o comeo desta seo).
+// Retorna 0 se faltar memria.
+int replanejarAPartirDe(int p, int desde) {
+    int livreBox[NUM_BOXES] = {0}, livreMecanico[NUM_MECANICOS] = {0};
+
+    // Reconstri quando cada box e cada mecnico fica livre ao fim da parte mantida
+    for (int i = 0; i < p; i++) {
+        if (agenda[i].fim > livreBox[agenda[i].box]) livreBox[agenda[i].box] = agenda[i].fim;
+        if (agenda[i].fim > livreMecanico[agenda[i].mecanico]) livreMecanico[agenda[i].mecanico] = agenda[i].fim;
+    }
+
+    int n = qtdAgenda - p;
+    if (n == 0) return 1;
+    Agendamento *pendentes = malloc(n * sizeof(Agendamento)); // Por minuto em que podem comear
+    Agendamento *fila = malloc(n * sizeof(Agendamento));      // As que j deram entrada
+    if (!pendentes || !fila) { free(pendentes); free(fila); return 0; }
+    memcpy(pendentes, &agenda[p], n * sizeof(Agendamento));
+    qsort(pendentes, n, sizeof(Agendamento), compararLiberacao);
+
+    int proxima = 0, tamFila = 0, t = desde;
+    for (int i = p; i < qtdAgenda; i++) {
+        // Prximo minuto com um box e um mecnico livres ao mesmo tempo
+        int b = menorLivre(livreBox, NUM_BOXES), m = menorLivre(livreMecanico, NUM_MECANICOS);
+        if (livreBox[b] > t) t = livreBox[b];
+        if (livreMecanico[m] > t) t = livreMecanico[m];
+        // Se nenhuma ordem espera, os recursos ficam parados at a prxima entrada
+        if (tamFila == 0 && pendentes[proxima].liberada > t) t = pendentes[proxima].liberada;
+        while (proxima < n && pendentes[proxima].liberada <= t) {
+            subirFila(fila, tamFila, pendentes[proxima++]);
+            tamFila++;
+        }
+
+        Agendamento a = fila[0];
+        fila[0] = fila[--tamFila];
+        descerFila(fila, tamFila, 0);
+        a.box = b;
+        a.mecanico = m;
+        a.inicio = t;
+        a.fim = t + a.duracao;
+        livreBox[b] = livreMecanico[m] = a.fim;
+        agenda[i] = a;
+    }
+    free(pendentes);
+    free(fila);
+    return 1;
+}
+
+// Funo: montarAgenda
+// Objetivo: montar a agenda do zero com todas as ordens abertas. Retorna 0 se faltar memria.
+int montarAgenda() {
+    qtdAgenda = 0;
+    agendaValida = 0;
+    if (!garantirCapacidadeAgenda(qtdOrdens)) return 0;
+
+    for (int i = 0; i < qtdOrdens; i++)
+        if (ordemAgendavel(&ordens[i])) preencherAgendamento(&agenda[qtdAgenda++], &ordens[i]);
+
+    if (!replanejarAPartirDe(0, 0)) return 0;
+    agendaValida = 1;
+    return 1;
+}
+
+// Funo: invalidarAgenda
+// Objetivo: descartar a agenda atual (ela ser montada de novo quando for consultada).
+// Usada quando muitas ordens mudam de uma vez, como na remoo em lote.
+void invalidarAgenda() {
+    agendaValida = 0;
+}
+
+// Funo: agendaAtualizarOrdem
+// Objetivo: refletir na agenda a incluso ou alterao de uma ordem sem remontar tudo:
+// retira o agendamento antigo, inclui o novo e refaz a agenda s a partir do primeiro
+// minuto que pode ter mudado.
+void agendaAtualizarOrdem(const OrdemServico *o) {
+    if (!agendaValida) return; // Ser montada do zero na prxima consulta
+
+    int desde = -1; // Primeiro minuto afetado (-1 = nada muda)
+
+    // Retira o agendamento antigo desta ordem, se existir
+    for (int i = 0; i < qtdAgenda; i++) {
+        if (agenda[i].id == o->id) {
+            desde = agenda[i].inicio;
+            memmove(&agenda[i], &agenda[i+1], (qtdAgenda - i - 1) * sizeof(Agendamento));
+            qtdAgenda--;
+            break;
+        }
+    }
+    int mantidos = qtdAgenda; // A ordem nova entra no fim, fora da busca abaixo
+
+    // Se a ordem continua aberta, entra de novo a partir do dia em que pode comear
+    if (ordemAgendavel(o)) {
+        if (!garantirCapacidadeAgenda(qtdAgenda + 1)) { invalidarAgenda(); return; }
+        preencherAgendamento(&agenda[qtdAgenda], o);
+        if (desde < 0 || agenda[qtdAgenda].liberada < desde) desde = agenda[qtdAgenda].liberada;
+        qtdAgenda++;
+    }
+    if (desde < 0) return;
+
+    // Mantm o que comea antes de 'desde' (busca binria: a agenda est em ordem de incio)
+    int ini = 0, fim = mantidos;
+    while (ini < fim) {
+        int meio = (ini + fim) / 2;
+        if (agenda[meio].inicio < desde) ini = meio + 1;
+        else fim = meio;
+    }
+    if (!replanejarAPartirDe(ini, desde)) invalidarAgenda();
+}
+
+// Funo: formatarHorario
+// Objetivo: converter minutos teis em "Dia N hh:mm". Para o horrio de trmino,
+// um servio que acaba no fim da jornada aparece como 16:00 do mesmo dia.
+void formatarHorario(char *buf, size_t tam, int minutos, int termino) {
+    int dia = (termino && minutos > 0) ? (minutos - 1) / MINUTOS_POR_DIA : minutos / MINUTOS_POR_DIA;
+    int resto = minutos - dia * MINUTOS_POR_DIA;
+    int hora = 8 * 60 + resto; // A jornada comea s 08:00
+    snprintf(buf, tam, "Dia %d %02d:%02d", dia + 1, hora / 60, hora % 60);
+}
+
+// Funo: mostrarAgenda
+// Objetivo: exibir a agenda da semana que comea na data informada (ou hoje)
+// e quantas ordens ficaram para depois.
+void mostrarAgenda() {
+    char data[32]; // Maior que "dd/mm/aaaa", para que o excesso torne a data invlida
+    printf("Semana a partir de (dd/mm/aaaa ou 0 para hoje): ");
+    if (scanf(" %31[^\n]", data) != 1) return;
+    scanf("%*[^\n]"); // Descarta o resto da linha
+    if (strcmp(data, "0") == 0) {
+        time_t agora = time(NULL);
+        struct tm *hoje = localtime(&agora);
+        snprintf(data, sizeof(data), "%02d/%02d/%04d", hoje->tm_mday, hoje->tm_mon + 1, hoje->tm_year + 1900);
+    }
+    if (!dataValida(data)) { printf("Data invlida!\n"); return; }
+    definirInicioAgenda(dataChave(data));
+
+    if (!agendaValida && !montarAgenda()) { printf("Erro de memria.\n"); return; }
+
+    int limiteSemana = MINUTOS_POR_DIA * DIAS_POR_SEMANA;
+    int naSemana = 0, depois = 0; // 'depois': s do entrada depois desta semana
+    printf("\n--- AGENDA DA SEMANA (%d boxes, %d mecnicos) ---\n", NUM_BOXES, NUM_MECANICOS);
+    printf("Dia 1 = primeiro dia til a partir de %s\n", data);
+    for (int i = 0; i < qtdAgenda; i++) {
+        if (agenda[i].inicio >= limiteSemana) { // S comea na semana seguinte
+            if (agenda[i].liberada >= limiteSemana) depois++;
+            continue;
+        }
+        char ini[32], fim[32];
+        formatarHorario(ini, sizeof(ini), agenda[i].inicio, 0);
+        formatarHorario(fim, sizeof(fim), agenda[i].fim, 1);
+        printf("%s at %s | Box %d | Mecnico %d | OS %d (%s) | %s\n",
+            ini, fim, agenda[i].box + 1, agenda[i].mecanico + 1, agenda[i].id,
+            agenda[i].placa[0] ? agenda[i].placa : "sem veculo",
+            agenda[i].prioridade == 0 ? "Reparo" : "Avaliao e reparo");
+        naSemana++;
+    }
+    if (qtdAgenda == 0) printf("Nenhuma ordem aberta.\n");
+    if (qtdAgenda - naSemana - depois > 0)
+        printf("%d ordem(ns) aberta(s) no cabe(m) nesta semana.\n", qtdAgenda - naSemana - depois);
+    if (depois > 0)
+        printf("%d ordem(ns) aberta(s) com entrada depois desta semana.\n", depois);
+}
+
+// ---------- Redimensionamento e compactao ----------
+// Veculos guardam ponteiros para clientes e ordens guardam ponteiros para veculos.
+// Sempre que um desses vetores muda de tamanho (realloc pode mudar o endereo) ou
+// tem registros removidos, os ponteiros das outras tabelas precisam ser refeitos.
+// 'novaPosicao' indica para qual posio cada registro antigo foi (-1 = removido);
+// NULL significa que ningum mudou de posio. As posies antigas so guardadas
+// (mapear*) antes de qualquer mudana, para que uma falta de memria no deixe
+// o vetor alterado pela metade.
+
+// Funo: mapearDonos
+// Objetivo: guardar a posio do dono de cada veculo (-1 = sem dono) enquanto o vetor de
+// clientes ainda est no endereo e na ordem atuais. Retorna NULL se faltar memria.
+int* mapearDonos() {
+    int *antigo = malloc((qtdVeiculos ? qtdVeiculos : 1) * sizeof(int));
+    if (!antigo) return NULL;
+    for (int i = 0; i < qtdVeiculos; i++) {
+        Cliente *d = veiculos[i].dono;
+        antigo[i] = (d >= clientes && d < clientes + qtdClientes) ? (int)(d - clientes) : -1;
+    }
+    return antigo;
+}
+
+// Funo: reapontarDonos
+// Objetivo: ajustar o vetor de clientes para 'novaQtd' posies e refazer o dono de cada
+// veculo a partir das posies guardadas em 'antigo' (ver mapearDonos).
+// Veculos cujo dono foi removido ficam sem dono (e a mudana  publicada).
+// Retorna a quantidade de veculos que perderam o dono, ou -1 se o vetor precisava
+// crescer e faltou memria (nesse caso nada foi alterado). Diminuir nunca falha.
+int reapontarDonos(int novaQtd, const int *novaPosicao, const int *antigo) {
+    if (novaQtd == 0) {
+        free(clientes);
+        clientes = NULL;
+    } else {
+        Cliente *novo = realloc(clientes, novaQtd * sizeof(Cliente));
+        if (!novo && novaQtd > qtdClientes) return -1;
+        if (novo) clientes = novo; // Se s estava diminuindo, o bloco antigo continua vlido
+    }
+
+    int semDono = 0;
+    for (int i = 0; i < qtdVeiculos; i++) {
+        if (antigo[i] < 0) continue; // No apontava para o vetor (sem dono)
+        int p = novaPosicao ? novaPosicao[antigo[i]] : antigo[i];
+        veiculos[i].dono = (p >= 0) ? &clientes[p] : NULL;
+        if (p < 0) { publicarVeiculo('U', &veiculos[i]); semDono++; }
+    }
+    return semDono;
+}
+
+// Funo: redimensionarClientes
+// Objetivo: mudar o tamanho do vetor de clientes sem mover ningum de posio,
+// mantendo os donos dos veculos corretos. Retorna -1 se faltar memria.
+int redimensionarClientes(int novaQtd) {
+    if (!prepararEscritaClientes() || !prepararEscritaVeiculos()) return -1;
+    int *antigo = mapearDonos();
+    if (!antigo) return -1;
+    int r = reapontarDonos(novaQtd, NULL, antigo);
+    free(antigo);
+    return r;
+}
+
+// Funo: mapearVeiculosDasOrdens
+// Objetivo: mesmo papel de mapearDonos, guardando a posio do veculo de cada ordem.
+int* mapearVeiculosDasOrdens() {
+    int *antigo = malloc((qtdOrdens ? qtdOrdens : 1) * sizeof(int));
+    if (!antigo) return NULL;
+    for (int i = 0; i < qtdOrdens; i++) {
+        Veiculo *v = ordens[i].veiculo;
+        antigo[i] = (v >= veiculos && v < veiculos + qtdVeiculos) ? (int)(v - veiculos) : -1;
+    }
+    return antigo;
+}
+
+// Funo: reapontarVeiculos
+// Objetivo: mesmo papel de reapontarDonos; ordens cujo veculo foi removido ficam sem veculo.
+int reapontarVeiculos(int novaQtd, const int *novaPosicao, const int *antigo) {
+    if (novaQtd == 0) {
+        free(veiculos);
+        veiculos = NULL;
+    } else {
+        Veiculo *novo = realloc(veiculos, novaQtd * sizeof(Veiculo));
+        if (!novo && novaQtd > qtdVeiculos) return -1;
+        if (novo) veiculos = novo;
+    }
+
+    int semVeiculo = 0;
+    for (int i = 0; i < qtdOrdens; i++) {
+        if (antigo[i] < 0) continue;
+        int p = novaPosicao ? novaPosicao[antigo[i]] : antigo[i];
+        ordens[i].veiculo = (p >= 0) ? &veiculos[p] : NULL;
+        if (p < 0) { publicarOrdem('U', &ordens[i]); semVeiculo++; }
+    }
+    return semVeiculo;
+}
+
+// Funo: redimensionarVeiculos
+// Objetivo: mesmo papel de redimensionarClientes, para o vetor de veculos.
+int redimensionarVeiculos(int novaQtd) {
+    if (!prepararEscritaVeiculos() || !prepararEscritaOrdens()) return -1;
+    int *antigo = mapearVeiculosDasOrdens();
+    if (!antigo) return -1;
+    int r = reapontarVeiculos(novaQtd, NULL, antigo);
+    free(antigo);
+    return r;
+}
+
+// Funo: compactarClientes
+// Objetivo: apagar de uma vez todos os clientes marcados em 'removido' (lpides).
+// Os restantes so deslocados em uma nica passada, mantendo a ordem original;
+// depois os ponteiros dos veculos so corrigidos e cada arquivo  salvo uma nica vez.
+// Retorna quantos clientes foram removidos, ou -1 se faltar memria (sem alterar nada).
+int compactarClientes(const char *removido) {
+    // Toda a memria auxiliar  reservada antes de mexer no vetor
+    if (!prepararEscritaClientes() || !prepararEscritaVeiculos()) return -1;
+    int *novaPosicao = malloc((qtdClientes ? qtdClientes : 1) * sizeof(int));
+    int *antigo = mapearDonos();
+    if (!novaPosicao || !antigo) { free(novaPosicao); free(antigo); return -1; }
+
+    int w = 0; // Prxima posio livre no vetor compactado
+    for (int i = 0; i < qtdClientes; i++) {
+        if (removido[i]) {
+            publicarCliente('D', &clientes[i]); // Registra antes de sobrescrever
+            novaPosicao[i] = -1;
+            continue;
+        }
+        if (w != i) clientes[w] = clientes[i];
+        novaPosicao[i] = w++;
+    }
+    int removidos = qtdClientes - w;
+    if (removidos == 0) { free(novaPosicao); free(antigo); return 0; }
+
+    int semDono = reapontarDonos(w, novaPosicao, antigo); // S diminui: no falha
+    qtdClientes = w;
+    free(novaPosicao);
+    free(antigo);
+
+    salvarClientes();
+    if (semDono > 0) salvarVeiculos(); // Algum veculo ficou sem dono
+    return removidos;
+}
+
+// Funo: compactarVeiculos
+// Objetivo: apagar de uma vez os veculos marcados; ordens desses veculos ficam sem veculo.
+int compactarVeiculos(const char *removido) {
+    if (!prepararEscritaVeiculos() || !prepararEscritaOrdens()) return -1;
+    int *novaPosicao = malloc((qtdVeiculos ? qtdVeiculos : 1) * sizeof(int));
+    int *antigo = mapearVeiculosDasOrdens();
+    if (!novaPosicao || !antigo) { free(novaPosicao); free(antigo); return -1; }
+
+    int w = 0;
+    for (int i = 0; i < qtdVeiculos; i++) {
+        if (removido[i]) {
+            publicarVeiculo('D', &veiculos[i]);
+            novaPosicao[i] = -1;
+            continue;
+        }
+        if (w != i) veiculos[w] = veiculos[i];
+        novaPosicao[i] = w++;
+    }
+    int removidos = qtdVeiculos - w;
+    if (removidos == 0) { free(novaPosicao); free(antigo); return 0; }
+
+    int semVeiculo = reapontarVeiculos(w, novaPosicao, antigo); // S diminui: no falha
+    qtdVeiculos = w;
+    free(novaPosicao);
+    free(antigo);
+
+    invalidarAgenda(); // A agenda guarda a placa de cada ordem
+    salvarVeiculos();
+    if (semVeiculo > 0) salvarOrdens(); // Alguma ordem ficou sem veculo
+    return removidos;
+}
+
+// Funo: compactarOrdens
+// Objetivo: apagar de uma vez as ordens marcadas (nenhuma outra tabela aponta para ordens).
+// Retorna quantas ordens foram removidas, ou -1 se faltar memria.
+int compactarOrdens(const char *removido) {
+    if (!prepararEscritaOrdens()) return -1;
+    int w = 0;
+    for (int i = 0; i < qtdOrdens; i++) {
+        if (removido[i]) {
+            publicarOrdem('D', &ordens[i]);
+            continue;
+        }
+        if (w != i) ordens[w] = ordens[i];
+        w++;
+    }
+    int removidos = qtdOrdens - w;
+    if (removidos == 0) return 0;
+
+    qtdOrdens = w;
+    if (qtdOrdens == 0) { free(ordens); ordens = NULL; }
+    else {
+        OrdemServico *novo = realloc(ordens, qtdOrdens * sizeof(OrdemServico));
+        if (novo) ordens = novo; // Se a reduo falhar, o bloco antigo continua vlido
+    }
+
+    invalidarAgenda(); // Vrias ordens podem ter sado: mais barato remontar na prxima consulta
+    salvarOrdens();
+    return removidos;
+}
+
 // ---------- Clientes ----------
 void cadastrarCliente() {
     char cpfTemp[20];
@@ -306,9 +1277,8 @@ void cadastrarCliente() {
     } while (!cpfValido(cpfTemp) || existe);  // Repete at CPF vlido e no repetido
 
     // Realoca memria para adicionar o novo cliente
-    Cliente *novo = realloc(clientes, (qtdClientes + 1) * sizeof(Cliente));
-    if (!novo) { printf("Erro de memria.\n"); return; }
-    clientes = novo;
+    // (se o vetor mudar de endereo, os donos dos veculos so reapontados)
+    if (redimensionarClientes(qtdClientes + 1) < 0) { printf("Erro de memria.\n"); return; }
  
     // Copia o CPF validado para o novo cliente
     strcpy(clientes[qtdClientes].cpf, cpfTemp);
@@ -330,6 +1300,7 @@ void cadastrarCliente() {
 
     // Atualiza a contagem e salva no arquivo
     qtdClientes++; salvarClientes();
+    publicarCliente('I', &clientes[qtdClientes-1]);
     printf("Cliente cadastrado!\n");
 }
 // ---------- CLIENTES ----------
@@ -339,6 +1310,7 @@ void atualizarCliente() {
     scanf(" %[^\n]", cpf); // L o CPF do cliente que ser atualizado
     for (int i = 0; i < qtdClientes; i++) {
         if (strcmp(clientes[i].cpf, cpf) == 0) { // Cliente encontrado
+            if (!prepararEscritaClientes()) { printf("Erro de memria.\n"); return; }
 
              // Permite atualizar nome e telefone
             printf("Novo nome: ");
@@ -349,6 +1321,7 @@ void atualizarCliente() {
 
             // Salva as alteraes no arquivo
             salvarClientes();
+            publicarCliente('U', &clientes[i]);
             printf("Cliente atualizado!\n");
             return;  // Sai da funo aps atualizar
         }
@@ -365,25 +1338,14 @@ void removerCliente() {
     for (int i = 0; i < qtdClientes; i++) {
         if (strcmp(clientes[i].cpf, cpf) == 0) {  // Cliente encontrado
 
-            // "Empurra" todos os elementos seguintes uma posio para trs
-            for (int j = i; j < qtdClientes-1; j++)
-                clientes[j] = clientes[j+1];
-
-            // Diminui a contagem total de clientes
-            qtdClientes--;
-
-            // Realoca o vetor de clientes para liberar memria no usada
-            Cliente *novo = realloc(clientes, qtdClientes * sizeof(Cliente));
-
-            // Se no h mais clientes, libera completamente o vetor
-            if (qtdClientes == 0) {
-                free(clientes); 
-                clientes = NULL; }
-            else if (novo) 
-            clientes = novo; // Atualiza o ponteiro caso a realocao d certo
-
-            // Salva as mudanas no arquivo
-            salvarClientes();
+            // Marca o cliente com uma lpide; a compactao desloca os seguintes,
+            // corrige os donos dos veculos e salva os arquivos
+            char *removido = calloc(qtdClientes, 1);
+            if (!removido) { printf("Erro de memria.\n"); return; }
+            removido[i] = 1;
+            int ok = compactarClientes(removido) > 0;
+            free(removido);
+            if (!ok) { printf("Erro de memria.\n"); return; }
 
             printf("Cliente removido!\n");
             return; // Sai da funo
@@ -412,9 +1374,8 @@ void cadastrarVeiculo() {
     } while (!placaTemp[0] || existe);  // Repete se a placa estiver vazia ou repetida
 
     // Realoca o vetor para incluir o novo veculo
-    Veiculo *novo = realloc(veiculos, (qtdVeiculos + 1) * sizeof(Veiculo));
-    if (!novo) { printf("Erro de memria.\n"); return; }
-    veiculos = novo;
+    // (se o vetor mudar de endereo, os veculos das ordens so reapontados)
+    if (redimensionarVeiculos(qtdVeiculos + 1) < 0) { printf("Erro de memria.\n"); return; }
 
     // Copia os dados bsicos do veculo
     strcpy(veiculos[qtdVeiculos].placa, placaTemp);
@@ -444,6 +1405,7 @@ void cadastrarVeiculo() {
     // Atualiza a contagem e salva os dados no arquivo
     qtdVeiculos++;
     salvarVeiculos();
+    publicarVeiculo('I', &veiculos[qtdVeiculos-1]);
     printf("Veculo cadastrado!\n");
 }
 void atualizarVeiculo() {
@@ -454,6 +1416,7 @@ void atualizarVeiculo() {
     // Procura o veculo com a placa informada
     for (int i = 0; i < qtdVeiculos; i++) {
         if (strcmp(veiculos[i].placa, placa) == 0) {  // Veculo encontrado
+            if (!prepararEscritaVeiculos()) { printf("Erro de memria.\n"); return; }
 
             // Permite editar o modelo e o ano
             printf("Novo modelo: ");
@@ -464,6 +1427,7 @@ void atualizarVeiculo() {
 
             // Salva as alteraes no arquivo
             salvarVeiculos();
+            publicarVeiculo('U', &veiculos[i]);
             printf("Veculo atualizado!\n");
             return;  // Sai da funo
         }
@@ -483,24 +1447,14 @@ void removerVeiculo() {
     for (int i = 0; i < qtdVeiculos; i++) {
         // Compara a placa informada com a placa de cada veculo
         if (strcmp(veiculos[i].placa, placa) == 0) {
-            // Caso encontre o veculo, realiza a "remoo lgica"
-            // movendo todos os veculos seguintes uma posio para trs
-            for (int j = i; j < qtdVeiculos-1; j++)
-                veiculos[j] = veiculos[j+1];
-            // Diminui o contador total de veculos
-            qtdVeiculos--;
-            // Realoca o vetor para liberar a memria no utilizada
-            Veiculo *novo = realloc(veiculos, qtdVeiculos * sizeof(Veiculo));
-
-            // Se no h mais veculos, libera completamente o espao da lista
-            if (qtdVeiculos == 0) { 
-            free(veiculos); 
-            veiculos = NULL; }
-            // Caso contrrio, atualiza o ponteiro se a realocao deu certo
-            else if (novo) veiculos = novo;
-
-            // Salva a nova lista atualizada no arquivo de persistncia
-            salvarVeiculos();
+            // Caso encontre o veculo, marca com uma lpide e compacta o vetor:
+            // os veculos seguintes andam uma posio para trs e as ordens so reapontadas
+            char *removido = calloc(qtdVeiculos, 1);
+            if (!removido) { printf("Erro de memria.\n"); return; }
+            removido[i] = 1;
+            int ok = compactarVeiculos(removido) > 0;
+            free(removido);
+            if (!ok) { printf("Erro de memria.\n"); return; }
 
             // Confirma ao usurio que o veculo foi removido
             printf("Veculo removido!\n");
@@ -514,12 +1468,15 @@ void removerVeiculo() {
 // ---------- Ordens ----------
 void abrirOrdem() {
     // Realoca o vetor de ordens para adicionar mais uma nova ordem
+    if (!prepararEscritaOrdens()) { printf("Erro de memria.\n"); return; }
     OrdemServico *novo = realloc(ordens, (qtdOrdens+1)*sizeof(OrdemServico));
     if (!novo) { // Se no conseguiu alocar memria, mostra erro e sai da funo
          printf("Erro de memria.\n"); return; }
     ordens = novo; // Atualiza o ponteiro principal com o novo espao de memria
     OrdemServico *nova = &ordens[qtdOrdens]; // Ponteiro para a nova posio (nova ordem)
-    nova->id = qtdOrdens+1;  // Define o ID automaticamente com base na quantidade atual
+    // Define o ID automaticamente: um a mais que o maior ID j usado. Esse valor 
+    // guardado em arquivo, ento o ID no se repete nem depois de remoes e reincios
+    nova->id = ultimoIdOrdem + 1;
 
     // ---------- Identificao do veculo ----------
     char placa[10];
@@ -555,7 +1512,11 @@ void abrirOrdem() {
 
     // Atualiza a quantidade total de ordens e salva tudo em arquivo
     qtdOrdens++;
+    ultimoIdOrdem = nova->id;
+    salvarUltimoIdOrdem();
     salvarOrdens();
+    publicarOrdem('I', nova);
+    agendaAtualizarOrdem(nova); // Encaixa a nova ordem na agenda
 
     // Confirma ao usurio que a ordem foi aberta com sucesso
     printf("Ordem aberta! ID: %d\n", nova->id);
@@ -569,6 +1530,7 @@ void atualizarOrdem() {
     // Percorre todas as ordens cadastradas para encontrar a que tem o ID informado
     for (int i = 0; i < qtdOrdens; i++) {
         if (ordens[i].id == id) {  // Se encontrou a ordem com o ID correspondente
+            if (!prepararEscritaOrdens()) { printf("Erro de memria.\n"); return; }
 
             // Atualiza a descrio da ordem
             printf("Nova descrio: ");
@@ -612,6 +1574,8 @@ void atualizarOrdem() {
 
             // Salva todas as alteraes no arquivo
             salvarOrdens();
+            publicarOrdem('U', &ordens[i]);
+            agendaAtualizarOrdem(&ordens[i]); // Status ou data podem ter mudado a posio na agenda
             printf("Ordem atualizada!\n");
             return; // Encerra a funo aps atualizar a ordem
         }
@@ -634,23 +1598,14 @@ void removerOrdem() {
         // Verifica se o ID informado corresponde a uma das ordens existentes
         if (ordens[i].id == id) {
 
-            // Desloca todas as ordens seguintes uma posio para trs,
-            // sobrescrevendo a ordem removida (efeito de "apagar" ela do meio do vetor)
-            for (int j = i; j < qtdOrdens-1; j++)
-                ordens[j] = ordens[j+1];
-
-            // Diminui o contador de ordens ativas    
-            qtdOrdens--;
-
-            // Realoca a memria para ajustar o tamanho do vetor 'ordens'
-            OrdemServico *novo = realloc(ordens, qtdOrdens * sizeof(OrdemServico));
-            if (qtdOrdens == 0) { free(ordens); ordens = NULL; }
-
-            // Caso contrrio, se o realloc foi bem-sucedido, atualiza o ponteiro principal
-            else if (novo) ordens = novo;
-
-            // Salva as alteraes no arquivo, garantindo persistncia dos dados
-            salvarOrdens();
+            // Marca a ordem com uma lpide e compacta o vetor,
+            // deslocando as ordens seguintes e salvando o arquivo
+            char *removido = calloc(qtdOrdens, 1);
+            if (!removido) { printf("Erro de memria.\n"); return; }
+            removido[i] = 1;
+            int ok = compactarOrdens(removido) > 0;
+            free(removido);
+            if (!ok) { printf("Erro de memria.\n"); return; }
 
             // Informa ao usurio que a remoo foi concluda
             printf("Ordem removida!\n");
@@ -666,49 +1621,583 @@ void removerOrdem() {
 // Funo: listarClientes
 // Objetivo: exibir na tela todos os clientes cadastrados no sistema
 void listarClientes() {
+    Snapshot *s = abrirSnapshot(); // L de uma cpia consistente dos dados
+    if (!s) { printf("Erro de memria.\n"); return; }
     printf("\n--- LISTA DE CLIENTES ---\n");
-    for (int i = 0; i < qtdClientes; i++) {
-        printf("%d - %s | CPF: %s | Tel: %s\n", i+1, clientes[i].nome, clientes[i].cpf, clientes[i].telefone);
+    for (int i = 0; i < s->qtdClientes; i++) {
+        printf("%d - %s | CPF: %s | Tel: %s\n", i+1, s->clientes[i].nome, s->clientes[i].cpf, s->clientes[i].telefone);
     }
+    liberarSnapshot(s);
 }
 // Funo: listarVeiculos
 // Objetivo: exibir todos os veculos cadastrados e seus respectivos donos
 void listarVeiculos() {
+    Snapshot *s = abrirSnapshot(); // L de uma cpia consistente dos dados
+    if (!s) { printf("Erro de memria.\n"); return; }
     printf("\n--- LISTA DE VECULOS ---\n");
     // Percorre o vetor de veculos
-    for (int i = 0; i < qtdVeiculos; i++) {
+    for (int i = 0; i < s->qtdVeiculos; i++) {
         // Exibe placa, modelo, ano e o nome do dono do veculo.
         // Caso o ponteiro 'dono' seja nulo, mostra "Desconhecido" (evita erro de acesso).
         printf("%d - %s | Modelo: %s | Ano: %d | Dono: %s\n", i+1,
-            veiculos[i].placa, veiculos[i].modelo, veiculos[i].ano,
-            veiculos[i].dono ? veiculos[i].dono->nome : "Desconhecido");
+            s->veiculos[i].placa, s->veiculos[i].modelo, s->veiculos[i].ano,
+            s->veiculos[i].dono ? s->veiculos[i].dono->nome : "Desconhecido");
     }
+    liberarSnapshot(s);
 }
 void listarOrdens() {
+    Snapshot *s = abrirSnapshot(); // L de uma cpia consistente dos dados
+    if (!s) { printf("Erro de memria.\n"); return; }
     printf("\n--- ORDENS DE SERVIO ---\n");
-    for (int i = 0; i < qtdOrdens; i++) {
+    for (int i = 0; i < s->qtdOrdens; i++) {
+        OrdemServico *o = &s->ordens[i];
         printf("ID %d | Veculo: %s | Data: %s | Status: %s | Problema: %s\n",
-            ordens[i].id,
-            ordens[i].veiculo ? ordens[i].veiculo->placa : "Desconhecido", // mostra a placa ou "Desconhecido" se no houver veculo associado
-            ordens[i].dataEntrada, // mostra a data de entrada da OS
-            statusTexto(ordens[i].status), // converte o status (enum) em texto legvel
-            ordens[i].descricao // mostra a descrio do problema
+            o->id,
+            o->veiculo ? o->veiculo->placa : "Desconhecido", // mostra a placa ou "Desconhecido" se no houver veculo associado
+            o->dataEntrada, // mostra a data de entrada da OS
+            statusTexto(o->status), // converte o status (enum) em texto legvel
+            o->descricao // mostra a descrio do problema
         );
     }
+    liberarSnapshot(s);
+}
+
+// ---------- Listagem paginada ----------
+// Para mostrar a pgina [inicio, inicio+limite) em uma ordem qualquer no  preciso
+// ordenar o vetor inteiro: basta selecionar os k = inicio+limite primeiros registros.
+// Isso  feito com um heap de mximo de tamanho k (o "pior" dos k fica na raiz),
+// custando O(n log k) em vez de O(n log n). Da pgina s interessam os 'limite' ltimos
+// desses k, que saem do heap um a um (do pior para o melhor) sem ordenar os demais.
+
+typedef int (*Comparador)(const void *a, const void *b);
+
+Comparador comparadorAtual = NULL; // Critrio escolhido pelo usurio
+int sentidoAtual = 1;              // 1 = crescente, -1 = decrescente
+
+// Data de entrada de cada ordem j convertida por dataChave, calculada uma vez por
+// listagem: chavesDataOrdens[i] corresponde a ordensChaveadas[i]
+const OrdemServico *ordensChaveadas = NULL;
+int *chavesDataOrdens = NULL;
+
+int compararClienteNome(const void *a, const void *b) {
+    return strcmp(((const Cliente*)a)->nome, ((const Cliente*)b)->nome);
+}
+int compararClienteCpf(const void *a, const void *b) {
+    return strcmp(((const Cliente*)a)->cpf, ((const Cliente*)b)->cpf);
+}
+int compararVeiculoPlaca(const void *a, const void *b) {
+    return strcmp(((const Veiculo*)a)->placa, ((const Veiculo*)b)->placa);
+}
+int compararVeiculoAno(const void *a, const void *b) {
+    int x = ((const Veiculo*)a)->ano, y = ((const Veiculo*)b)->ano;
+    return (x > y) - (x < y);
+}
+int compararVeiculoModelo(const void *a, const void *b) {
+    return strcmp(((const Veiculo*)a)->modelo, ((const Veiculo*)b)->modelo);
+}
+int compararOrdemData(const void *a, const void *b) {
+    int x = chavesDataOrdens[(const OrdemServico*)a - ordensChaveadas];
+    int y = chavesDataOrdens[(const OrdemServico*)b - ordensChaveadas];
+    return (x > y) - (x < y);
+}
+int compararOrdemStatus(const void *a, const void *b) {
+    int x = ((const OrdemServico*)a)->status, y = ((const OrdemServico*)b)->status;
+    return (x > y) - (x < y);
+}
+int compararOrdemId(const void *a, const void *b) {
+    int x = ((const OrdemServico*)a)->id, y = ((const OrdemServico*)b)->id;
+    return (x > y) - (x < y);
+}
+
+// Funo: compararRegistros
+// Objetivo: aplicar o critrio e o sentido escolhidos. Em caso de empate, mantm a
+// ordem de cadastro (todos os registros esto no mesmo vetor), deixando a paginao estvel.
+int compararRegistros(const void *a, const void *b) {
+    int r = comparadorAtual(a, b) * sentidoAtual;
+    if (r != 0) return r;
+    return ((const char*)a > (const char*)b) - ((const char*)a < (const char*)b);
+}
+
+// Funo: descerTopK
+// Objetivo: colocar 'item' na posio i do heap de mximo (com 'tam' itens) e desc-lo
+// at que nenhum filho seja maior que ele.
+void descerTopK(const void **heap, int tam, int i, const void *item) {
+    for (;;) {
+        int filho = 2*i + 1;
+        if (filho >= tam) break;
+        if (filho + 1 < tam && compararRegistros(heap[filho+1], heap[filho]) > 0) filho++;
+        if (compararRegistros(heap[filho], item) <= 0) break;
+        heap[i] = heap[filho];
+        i = filho;
+    }
+    heap[i] = item;
+}
+
+// Funo: inserirTopK
+// Objetivo: oferecer um registro ao heap que guarda os k primeiros encontrados at agora.
+void inserirTopK(const void **heap, int *tam, int k, const void *item) {
+    int i;
+    if (*tam < k) {
+        // Ainda h espao: insere no fim e sobe enquanto for maior que o pai
+        i = (*tam)++;
+        while (i > 0 && compararRegistros(heap[(i-1)/2], item) < 0) {
+            heap[i] = heap[(i-1)/2];
+            i = (i-1)/2;
+        }
+        heap[i] = item;
+        return;
+    }
+    // Heap cheio: s entra se for melhor que o pior (raiz); nesse caso substitui a raiz e desce
+    if (k == 0 || compararRegistros(item, heap[0]) >= 0) return;
+    descerTopK(heap, k, 0, item);
+}
+
+// Funo: contemTexto
+// Objetivo: filtro por trecho de texto; "*" significa "sem filtro".
+int contemTexto(const char *campo, const char *filtro) {
+    return strcmp(filtro, "*") == 0 || strstr(campo, filtro) != NULL;
+}
+
+// Funo: descartarLinha
+// Objetivo: descartar o que sobrou da linha digitada, para que no responda a prxima pergunta.
+void descartarLinha() {
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF) {}
+}
+
+// Funo: lerInteiro
+// Objetivo: ler um nmero inteiro e descartar o resto da linha. Se o que foi digitado
+// no for um nmero, retorna 0, para quem chamou cancelar.
+int lerInteiro(int *valor) {
+    int ok = scanf("%d", valor) == 1;
+    descartarLinha();
+    return ok;
+}
+
+// Funo: listagemPaginada
+// Objetivo: listar clientes, veculos ou ordens com filtro, critrio de ordenao,
+// sentido e paginao (a partir de qual item e quantos itens mostrar).
+void listagemPaginada() {
+    int tipo, criterio, sentido, inicio = 1, limite = 1, statusFiltro = 0;
+    char filtro[100];
+
+    printf("Listar (1-Clientes 2-Veculos 3-Ordens): ");
+    if (!lerInteiro(&tipo) || tipo < 1 || tipo > 3) { printf("Opo invlida!\n"); return; }
+
+    if (tipo == 1) {
+        printf("Ordenar por (1-Nome 2-CPF): ");
+        if (!lerInteiro(&criterio) || criterio < 1 || criterio > 2) { printf("Opo invlida!\n"); return; }
+        comparadorAtual = (criterio == 2) ? compararClienteCpf : compararClienteNome;
+        printf("Filtrar por nome contendo (* para todos): ");
+    } else if (tipo == 2) {
+        printf("Ordenar por (1-Placa 2-Ano 3-Modelo): ");
+        if (!lerInteiro(&criterio) || criterio < 1 || criterio > 3) { printf("Opo invlida!\n"); return; }
+        comparadorAtual = (criterio == 2) ? compararVeiculoAno
+                        : (criterio == 3) ? compararVeiculoModelo : compararVeiculoPlaca;
+        printf("Filtrar por modelo contendo (* para todos): ");
+    } else {
+        printf("Ordenar por (1-Data 2-Status 3-ID): ");
+        if (!lerInteiro(&criterio) || criterio < 1 || criterio > 3) { printf("Opo invlida!\n"); return; }
+        comparadorAtual = (criterio == 2) ? compararOrdemStatus
+                        : (criterio == 3) ? compararOrdemId : compararOrdemData;
+        printf("Filtrar por status (0-Todos 1-Aguardando 2-Reparo 3-Finalizado 4-Entregue): ");
+        if (!lerInteiro(&statusFiltro) || statusFiltro < 0 || statusFiltro > 4) { printf("Opo invlida!\n"); return; }
+        printf("Filtrar por descrio contendo (* para todos): ");
+    }
+    if (scanf(" %99[^\n]", filtro) != 1) { printf("Opo invlida!\n"); return; }
+    descartarLinha(); // Um filtro maior que o campo no pode responder a prxima pergunta
+
+    printf("Sentido (1-Crescente 2-Decrescente): ");
+    if (!lerInteiro(&sentido) || sentido < 1 || sentido > 2) { printf("Opo invlida!\n"); return; }
+    sentidoAtual = (sentido == 2) ? -1 : 1;
+
+    printf("Comear a partir do item: ");
+    if (!lerInteiro(&inicio)) { printf("Opo invlida!\n"); return; }
+    printf("Quantidade de itens por pgina: ");
+    if (!lerInteiro(&limite)) { printf("Opo invlida!\n"); return; }
+    if (inicio < 1) inicio = 1;
+    if (limite < 1) limite = 1;
+
+    Snapshot *s = abrirSnapshot(); // A pgina inteira vem da mesma verso dos dados
+    if (!s) { printf("Erro de memria.\n"); return; }
+
+    int total = (tipo == 1) ? s->qtdClientes : (tipo == 2) ? s->qtdVeiculos : s->qtdOrdens;
+    if (inicio > total) {
+        printf("Nenhum item nesta pgina.\n");
+        liberarSnapshot(s);
+        return;
+    }
+    // S  preciso guardar os k primeiros (nunca mais que o total de registros).
+    // O limite  reduzido antes da soma para que valores enormes no estourem o int.
+    if (limite > total) limite = total;
+    int k = inicio - 1 + limite;
+    if (k > total) k = total;
+
+    const void **heap = malloc((k > 0 ? k : 1) * sizeof(const void*));
+    if (!heap) { liberarSnapshot(s); printf("Erro de memria.\n"); return; }
+    int tam = 0, encontrados = 0;
+
+    // Ordenando por data: converte cada data uma nica vez, e no a cada comparao
+    if (comparadorAtual == compararOrdemData) {
+        chavesDataOrdens = malloc((total ? total : 1) * sizeof(int));
+        if (!chavesDataOrdens) { free(heap); liberarSnapshot(s); printf("Erro de memria.\n"); return; }
+        for (int i = 0; i < total; i++) chavesDataOrdens[i] = dataChave(s->ordens[i].dataEntrada);
+        ordensChaveadas = s->ordens;
+    }
+
+    // Percorre a tabela uma nica vez, aplicando o filtro e alimentando o heap
+    for (int i = 0; i < total; i++) {
+        const void *item;
+        if (tipo == 1) {
+            if (!contemTexto(s->clientes[i].nome, filtro)) continue;
+            item = &s->clientes[i];
+        } else if (tipo == 2) {
+            if (!contemTexto(s->veiculos[i].modelo, filtro)) continue;
+            item = &s->veiculos[i];
+        } else {
+            if (statusFiltro && (int)s->ordens[i].status != statusFiltro) continue;
+            if (!contemTexto(s->ordens[i].descricao, filtro)) continue;
+            item = &s->ordens[i];
+        }
+        encontrados++;
+        inserirTopK(heap, &tam, k, item);
+    }
+
+    // Retira do heap s os itens da pgina, do pior para o melhor. Cada um vai para o
+    // fim da parte ocupada, ento heap[inicio-1 .. tam-1] fica em ordem crescente.
+    int tamHeap = tam;
+    while (tamHeap > inicio - 1) {
+        const void *maior = heap[0];
+        tamHeap--;
+        if (tamHeap > 0) descerTopK(heap, tamHeap, 0, heap[tamHeap]);
+        heap[tamHeap] = maior;
+    }
+
+    printf("\n--- RESULTADO (%d encontrado(s)) ---\n", encontrados);
+    for (int i = inicio - 1; i < tam; i++) {
+        if (tipo == 1) {
+            const Cliente *c = heap[i];
+            printf("%d - %s | CPF: %s | Tel: %s\n", i+1, c->nome, c->cpf, c->telefone);
+        } else if (tipo == 2) {
+            const Veiculo *v = heap[i];
+            printf("%d - %s | Modelo: %s | Ano: %d | Dono: %s\n", i+1,
+                v->placa, v->modelo, v->ano, v->dono ? v->dono->nome : "Desconhecido");
+        } else {
+            const OrdemServico *o = heap[i];
+            printf("%d - ID %d | Veculo: %s | Data: %s | Status: %s | Problema: %s\n", i+1,
+                o->id, o->veiculo ? o->veiculo->placa : "Desconhecido",
+                o->dataEntrada, statusTexto(o->status), o->descricao);
+        }
+    }
+    if (inicio > tam) printf("Nenhum item nesta pgina.\n");
+
+    free(chavesDataOrdens);
+    chavesDataOrdens = NULL;
+    ordensChaveadas = NULL;
+    free(heap);
+    liberarSnapshot(s);
+}
+
+// ---------- Remoo em lote ----------
+// Em vez de remover um registro por vez (deslocando o vetor e regravando o arquivo
+// a cada remoo), todos os registros escolhidos so marcados com uma lpide e o vetor
+//  compactado uma nica vez (ver compactarClientes/Veiculos/Ordens).
+
+typedef char Chave[20]; // Cabe um CPF, uma placa ou um ID
+
+int compararChaves(const void *a, const void *b) {
+    return strcmp((const char*)a, (const char*)b);
+}
+
+// Funo: lerChaves
+// Objetivo: ler uma lista de chaves digitadas separadas por espao ou, se a entrada
+// comear com '@', de um arquivo com uma chave por linha. A lista volta ordenada,
+// para que cada consulta seja feita com busca binria.
+// Retorna o vetor (liberar com free) e a quantidade em 'qtd'; NULL se a entrada terminar,
+// faltar memria, o arquivo no abrir ou alguma chave for longa demais.
+Chave* lerChaves(int *qtd) {
+    char entrada[1024];
+    printf("Chaves separadas por espao (ou @arquivo.txt com uma por linha): ");
+    if (scanf(" ") != 0 || !fgets(entrada, sizeof(entrada), stdin)) return NULL;
+    // Uma lista que no coube seria cortada, e o resto dela responderia a confirmao
+    if (!strchr(entrada, '\n') && !feof(stdin)) {
+        int c = getchar();
+        if (c != '\n' && c != EOF) {
+            descartarLinha();
+            printf("Lista longa demais, use @arquivo.\n");
+            return NULL;
+        }
+    }
+    entrada[strcspn(entrada, "\r\n")] = '\0';
+
+    Chave *lista = NULL;
+    int n = 0, cap = 0;
+    FILE *f = NULL;
+    char *token = NULL;
+    char linha[100];
+
+    if (entrada[0] == '@') {
+        f = fopen(entrada + 1, "r");
+        if (!f) { printf("No foi possvel abrir o arquivo.\n"); return NULL; }
+    } else {
+        token = strtok(entrada, " ,");
+    }
+
+    for (;;) {
+        if (f) {
+            if (!fgets(linha, sizeof(linha), f)) break;
+            linha[strcspn(linha, "\r\n")] = '\0';
+            if (linha[0] == '\0') continue; // Ignora linhas em branco
+            token = linha;
+        } else if (!token) break;
+
+        // Cresce o vetor dobrando a capacidade, para no realocar a cada chave
+        if (n == cap) {
+            cap = cap ? cap * 2 : 16;
+            Chave *novo = realloc(lista, cap * sizeof(Chave));
+            if (!novo) { free(lista); if (f) fclose(f); return NULL; }
+            lista = novo;
+        }
+        // Uma chave cortada poderia coincidir com outra existente: recusa em vez de cortar
+        if (strlen(token) >= sizeof(Chave)) {
+            printf("Chave longa demais: %.19s...\n", token);
+            free(lista);
+            if (f) fclose(f);
+            return NULL;
+        }
+        strcpy(lista[n++], token);
+
+        if (!f) token = strtok(NULL, " ,");
+    }
+    if (f) fclose(f);
+
+    if (n > 0) qsort(lista, n, sizeof(Chave), compararChaves);
+    *qtd = n;
+    return lista ? lista : malloc(sizeof(Chave)); // Lista vazia continua sendo um vetor vlido
+}
+
+// Funo: chaveNaLista
+// Objetivo: verificar (por busca binria) se a chave est na lista ordenada.
+int chaveNaLista(const char *chave, const Chave *lista, int qtd) {
+    return qtd > 0 && bsearch(chave, lista, qtd, sizeof(Chave), compararChaves) != NULL;
+}
+
+int compararInteiros(const void *a, const void *b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Funo: chavesComoIds
+// Objetivo: converter a lista de chaves em IDs de ordem (para que "003" e "3" sejam a
+// mesma ordem), devolvendo um vetor ordenado para busca binria.
+// Retorna NULL se alguma chave no for um ID vlido ou se faltar memria.
+int* chavesComoIds(const Chave *lista, int qtd) {
+    int *ids = malloc((qtd ? qtd : 1) * sizeof(int));
+    if (!ids) { printf("Erro de memria.\n"); return NULL; }
+    for (int k = 0; k < qtd; k++) {
+        char *fim;
+        errno = 0;
+        long id = strtol(lista[k], &fim, 10);
+        if (fim == lista[k] || *fim != '\0' || errno == ERANGE || id < 1 || id > INT_MAX) {
+            printf("ID invlido: %s\n", lista[k]);
+            free(ids);
+            return NULL;
+        }
+        ids[k] = (int)id;
+    }
+    qsort(ids, qtd, sizeof(int), compararInteiros);
+    return ids;
+}
+
+// Funo: removerEmLote
+// Objetivo: remover de uma s vez vrios clientes, veculos ou ordens, escolhidos por
+// uma lista de chaves ou por um critrio. Veculos de clientes removidos ficam sem dono
+// e ordens de veculos removidos ficam sem veculo.
+void removerEmLote() {
+    int tipo, modo, total, marcados = 0;
+    printf("Remover em lote (1-Clientes 2-Veculos 3-Ordens): ");
+    if (!lerInteiro(&tipo) || tipo < 1 || tipo > 3) { printf("Opo invlida!\n"); return; }
+
+    if (tipo == 1) printf("Escolher por (1-Lista de CPFs 2-Clientes sem veculo): ");
+    else if (tipo == 2) printf("Escolher por (1-Lista de placas 2-Ano anterior a): ");
+    else printf("Escolher por (1-Lista de IDs 2-Status e data de entrada anterior a): ");
+    if (!lerInteiro(&modo) || (modo != 1 && modo != 2)) { printf("Opo invlida!\n"); return; }
+
+    total = (tipo == 1) ? qtdClientes : (tipo == 2) ? qtdVeiculos : qtdOrdens;
+    char *removido = calloc(total ? total : 1, 1); // Lpides: 1 = ser removido
+    if (!removido) { printf("Erro de memria.\n"); return; }
+
+    if (modo == 1) {
+        int qtdChaves = 0;
+        Chave *lista = lerChaves(&qtdChaves);
+        if (!lista) { printf("Remoo cancelada.\n"); free(removido); return; }
+        if (tipo == 3) {
+            // IDs so comparados como nmeros, e no como texto
+            int *ids = chavesComoIds(lista, qtdChaves);
+            free(lista);
+            if (!ids) { printf("Remoo cancelada.\n"); free(removido); return; }
+            for (int i = 0; i < total; i++)
+                removido[i] = qtdChaves > 0 &&
+                              bsearch(&ordens[i].id, ids, qtdChaves, sizeof(int), compararInteiros) != NULL;
+            free(ids);
+        } else {
+            for (int i = 0; i < total; i++)
+                removido[i] = (char)chaveNaLista(tipo == 1 ? clientes[i].cpf : veiculos[i].placa, lista, qtdChaves);
+            free(lista);
+        }
+    } else if (tipo == 1) {
+        // Marca todos e desmarca quem  dono de algum veculo
+        memset(removido, 1, total);
+        for (int i = 0; i < qtdVeiculos; i++) {
+            Cliente *d = veiculos[i].dono;
+            if (d >= clientes && d < clientes + qtdClientes) removido[d - clientes] = 0;
+        }
+    } else if (tipo == 2) {
+        int ano;
+        printf("Remover veculos com ano anterior a: ");
+        if (!lerInteiro(&ano)) { printf("Remoo cancelada.\n"); free(removido); return; }
+        for (int i = 0; i < total; i++) removido[i] = veiculos[i].ano < ano;
+    } else {
+        int status;
+        char data[32]; // Maior que "dd/mm/aaaa", para que o excesso torne a data invlida em vez de sobrar
+        printf("Status (0-Qualquer 1-Aguardando 2-Reparo 3-Finalizado 4-Entregue): ");
+        if (!lerInteiro(&status) || status < 0 || status > 4) {
+            printf("Remoo cancelada.\n");
+            free(removido);
+            return;
+        }
+        do {
+            printf("Remover ordens com data de entrada anterior a (dd/mm/aaaa): ");
+            if (scanf(" %31[^\n]", data) != 1) { printf("Remoo cancelada.\n"); free(removido); return; }
+            descartarLinha();
+        } while (!dataValida(data));
+        int limite = dataChave(data);
+        for (int i = 0; i < total; i++)
+            removido[i] = (status == 0 || (int)ordens[i].status == status) &&
+                          dataChave(ordens[i].dataEntrada) < limite;
+    }
+
+    for (int i = 0; i < total; i++) marcados += removido[i];
+    if (marcados == 0) { printf("Nenhum registro encontrado.\n"); free(removido); return; }
+
+    // Toda resposta anterior foi lida at o fim da linha: nada digitado antes pode confirmar
+    int confirma = 0;
+    printf("Confirmar a remoo de %d registro(s)? (1-Sim 0-No): ", marcados);
+    if (!lerInteiro(&confirma) || confirma != 1) { printf("Remoo cancelada.\n"); free(removido); return; }
+
+    // Uma nica compactao e uma nica gravao por arquivo afetado
+    int removidos = (tipo == 1) ? compactarClientes(removido)
+                  : (tipo == 2) ? compactarVeiculos(removido)
+                  : compactarOrdens(removido);
+    free(removido);
+
+    if (removidos < 0) printf("Erro de memria.\n");
+    else printf("%d registro(s) removido(s)!\n", removidos);
+}
+
+// ---------- Benchmark da agenda ----------
+
+// Funo: benchmarkAgenda
+// Objetivo: gerar 'n' ordens sintticas em memria e medir quanto tempo leva para
+// montar a agenda do zero e para reagendar aps mudanas de status isoladas.
+// No fim confere se a agenda atualizada aos poucos  igual a uma montada do zero.
+void benchmarkAgenda(int n) {
+    if (n < 1) n = 1;
+    ordens = malloc(n * sizeof(OrdemServico));
+    if (!ordens) { printf("Erro de memria.\n"); return; }
+    qtdOrdens = n;
+
+    srand(42); // Semente fixa: o mesmo conjunto de dados a cada execuo
+    for (int i = 0; i < n; i++) {
+        ordens[i].id = i + 1;
+        ordens[i].veiculo = NULL;
+        char data[16];
+        snprintf(data, sizeof(data), "%02d/%02d/2024", 1 + rand() % 28, 1 + rand() % 12);
+        memcpy(ordens[i].dataEntrada, data, sizeof(ordens[i].dataEntrada)); // "dd/mm/aaaa" + '\0'
+        ordens[i].descricao[0] = '\0';
+        ordens[i].status = (Status)(1 + rand() % 4);
+    }
+
+    definirInicioAgenda(20240701); // No meio do ano: parte das ordens ainda nem deu entrada
+    clock_t t0 = clock();
+    if (!montarAgenda()) {
+        printf("Erro de memria.\n");
+        free(ordens);
+        ordens = NULL;
+        qtdOrdens = 0;
+        return;
+    }
+    double msMontar = 1000.0 * (clock() - t0) / CLOCKS_PER_SEC;
+
+    int limiteSemana = MINUTOS_POR_DIA * DIAS_POR_SEMANA, naSemana = 0;
+    for (int i = 0; i < qtdAgenda; i++) if (agenda[i].inicio < limiteSemana) naSemana++;
+
+    // Mudanas de status isoladas, como as feitas em atualizarOrdem
+    int mudancas = 1000;
+    t0 = clock();
+    for (int k = 0; k < mudancas; k++) {
+        OrdemServico *o = &ordens[rand() % n];
+        o->status = (Status)(1 + rand() % 4);
+        agendaAtualizarOrdem(o);
+    }
+    double msMudancas = 1000.0 * (clock() - t0) / CLOCKS_PER_SEC;
+
+    // Conferncia: a agenda incremental deve ser idntica a uma remontada do zero
+    int qtdIncremental = qtdAgenda, iguais = 0;
+    Agendamento *incremental = malloc((qtdAgenda ? qtdAgenda : 1) * sizeof(Agendamento));
+    if (incremental) {
+        memcpy(incremental, agenda, qtdAgenda * sizeof(Agendamento));
+        montarAgenda();
+        iguais = qtdIncremental == qtdAgenda;
+        for (int i = 0; iguais && i < qtdAgenda; i++)
+            iguais = compararAgendamentos(&incremental[i], &agenda[i]) == 0 &&
+                     incremental[i].box == agenda[i].box && incremental[i].mecanico == agenda[i].mecanico &&
+                     incremental[i].inicio == agenda[i].inicio && incremental[i].fim == agenda[i].fim;
+        free(incremental);
+    }
+
+    printf("Ordens: %d | Abertas: %d | Na semana: %d (%d boxes, %d mecnicos)\n",
+        n, qtdIncremental, naSemana, NUM_BOXES, NUM_MECANICOS);
+    printf("Montar agenda: %.3f ms\n", msMontar);
+    printf("%d mudanas de status: %.3f ms (%.4f ms por mudana)\n",
+        mudancas, msMudancas, msMudancas / mudancas);
+    printf("Agenda incremental igual  remontada: %s\n", iguais ? "sim" : "no");
+
+    free(agenda);
+    agenda = NULL;
+    qtdAgenda = capAgenda = 0;
+    free(ordens);
+    ordens = NULL;
+    qtdOrdens = 0;
 }
 
 // ---------- Menu principal ----------
-int main() {
+int main(int argc, char *argv[]) {
     setlocale(LC_ALL,""); // usar local do sistema para mostrar as palavras acentuadas
+
+    // Modo consumidor: "oficina --alteracoes N" imprime os eventos aps a sequncia N e sai
+    if (argc >= 2 && strcmp(argv[1], "--alteracoes") == 0) {
+        listarAlteracoes(argc >= 3 ? strtoul(argv[2], NULL, 10) : 0);
+        return 0;
+    }
+    // "oficina --benchmark-agenda N" mede a agenda com N ordens sintticas (no toca nos arquivos)
+    if (argc >= 2 && strcmp(argv[1], "--benchmark-agenda") == 0) {
+        benchmarkAgenda(argc >= 3 ? atoi(argv[2]) : 5000);
+        return 0;
+    }
+
     carregarClientes();
     carregarVeiculos();
     carregarOrdens();
+    carregarUltimoIdOrdem();
+    abrirAlteracoes();
     int opc;
     do {
         printf("\n===== OFICINA MECNICA =====\n");
         printf("1 - Cadastrar Cliente\n2 - Atualizar Cliente\n3 - Remover Cliente\n4 - Listar Clientes\n");
         printf("5 - Cadastrar Veculo\n6 - Atualizar Veculo\n7 - Remover Veculo\n8 - Listar Veculos\n");
         printf("9 - Abrir Ordem\n10 - Atualizar Ordem\n11 - Remover Ordem\n12 - Listar Ordens\n");
+        printf("13 - Listagem Paginada\n14 - Remoo em Lote\n15 - Agenda da Semana\n");
         printf("0 - Sair\nEscolha: ");
         if (scanf("%d",&opc) != 1) { // evita loop infinito em entrada invlida
             while (getchar() != '\n') {}
@@ -740,6 +2229,12 @@ int main() {
             break;
             case 12: listarOrdens();     // Lista todas as ordens cadastradas com seus status
             break;
+            case 13: listagemPaginada(); // Lista com filtro, ordenao e paginao
+            break;
+            case 14: removerEmLote();    // Remove vrios registros de uma vez
+            break;
+            case 15: mostrarAgenda();    // Distribui as ordens abertas entre boxes e mecnicos
+            break;
            // ---------- Sada ----------
             case 0: printf("Encerrando...\n"); // Mensagem exibida ao encerrar o programa
             break;
@@ -749,6 +2244,12 @@ int main() {
     } while (opc != 0);
 
     // Libera toda a memoria alocada antes de sair
+    // Sem leitores abertos, as verses s referenciam os vetores liberados abaixo
+    free(versaoClientes);
+    free(versaoVeiculos);
+    free(versaoOrdens);
+    if (arquivoAlteracoes) fclose(arquivoAlteracoes);
+    free(agenda);
     free(clientes);
     free(veiculos);
     free(ordens);